@@ -0,0 +1,148 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "partitionCounting.h"
+#include "countProtocol.h"
+
+
+using namespace std;
+
+#include <iomanip>
+#include <chrono>
+typedef std::chrono::high_resolution_clock Clock;
+
+static void show_usage(std::string name)
+{
+    std::cerr << "Usage: " << name << " <option(s)>"
+              << "Options:\n"
+              << "\t-h,--help\t\tShow this help message\n"
+              << "\t-s, PATH\tSpecify the path of the daemon socket. Default: " << COUNT_SOCKET_DEFAULT << "\n"
+              << "\t-n, NUM\tSpecify the number n from which the queried partitions are generated. Default: 15.\n"
+              << "\t-w, NUM\tSpecify the number of pipelined requests in flight. Default: 64.\n"
+              << "\t-r, NUM\tSpecify the number of passes over the queries. Default: 3."
+              << std::endl;
+}
+
+// Sends the queries one at a time and records the round-trip time of each of them (in microseconds)
+static bool latencyPass(int fd, const std::vector<std::string> &frames, std::vector<double> &latencies) {
+  char frame[COUNT_RESPONSE_SIZE];
+  latencies.clear();
+  for (auto &f : frames) {
+    auto t1 = Clock::now();
+    if (!writeAll(fd,f.data(),f.size()) || !readAll(fd,frame,COUNT_RESPONSE_SIZE))
+      return false;
+    auto t2 = Clock::now();
+    latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()/1000.0);
+  }
+  return true;
+}
+
+// Sends the queries keeping up to window requests in flight; returns the elapsed time in seconds
+static double throughputPass(int fd, const std::vector<std::string> &frames, unsigned int window) {
+  char frame[COUNT_RESPONSE_SIZE];
+  size_t sent = 0, received = 0;
+  auto t1 = Clock::now();
+  while (received<frames.size()) {
+    // Fill the window with a single write
+    std::string batch;
+    while (sent<frames.size() && sent-received<window)
+      batch += frames[sent++];
+    if (!batch.empty() && !writeAll(fd,batch.data(),batch.size()))
+      return -1.0;
+    if (!readAll(fd,frame,COUNT_RESPONSE_SIZE))
+      return -1.0;
+    received++;
+  }
+  auto t2 = Clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count()*1e-9;
+}
+
+int main(int argc, char *argv[]) {
+  std::string path = COUNT_SOCKET_DEFAULT;
+  int n = 15;
+  unsigned int window = 64;
+  int passes = 3;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "-h") || (arg == "--help")) {
+        show_usage(argv[0]);
+        return 0;
+    } else if ((arg == "-s") || (arg == "-n") || (arg == "-w") || (arg == "-r")) {
+        if (i + 1 < argc) { // Make sure we aren't at the end of argv!
+            std::string value = argv[++i];
+            if (arg == "-s") path = value;
+            else if (arg == "-n") n = atoi(value.c_str());
+            else if (arg == "-w") window = std::max(1,atoi(value.c_str()));
+            else passes = atoi(value.c_str());
+        } else { // Uh-oh, there was no argument to the destination option.
+            std::cerr << "The " << arg << " option requires one argument." << std::endl;
+            return 1;
+        }
+    } else {
+      show_usage(argv[0]);
+      return 1;
+    }
+  }
+  if (n<2 || n>SMAX) {
+    cerr << "[ERR] n should be between 2 and " << SMAX << endl;
+    return 1;
+  }
+
+  // Queries: all the pairs of partitions of n such that the second one descends from the first one
+  std::list<std::vector<unsigned int> >partitionsOfN;
+  ascPartition(n,partitionsOfN);
+  std::vector<unsigned int> trivialPartition; trivialPartition.push_back(n);
+  partitionsOfN.push_back(trivialPartition);
+  std::vector<partitionDescriptor> P;
+  for (auto partition: partitionsOfN) {
+    P.push_back(partitionDescriptor(partition,n));
+  }
+  std::vector<std::string> frames;
+  for (unsigned int j=0; j<P.size(); j++)
+    for (unsigned int i=0; i<j; i++)
+      if (P[j].descendent(P[i])) {
+        countRequest request;
+        request.id = frames.size();
+        for (int k=0;k<n;k++) {
+          request.init.push_back(P[i][k]);
+          request.end.push_back(P[j][k]);
+        }
+        frames.push_back(std::string());
+        encodeRequest(request,frames.back());
+      }
+  cout << "[INF] " << frames.size() << " queries over " << P.size() << " partitions of n=" << n << endl;
+
+  int fd = connectDaemon(path);
+  if (fd<0) {
+    cerr << "[ERR] Cannot connect to " << path << ": " << strerror(errno) << endl;
+    return 1;
+  }
+  cout << fixed << setprecision(2);
+  std::vector<double> latencies;
+  for (int p=0; p<passes; p++) {
+    if (!latencyPass(fd,frames,latencies)) {
+      cerr << "[ERR] Connection lost" << endl;
+      return 1;
+    }
+    double total = 0.0;
+    for (auto l : latencies) total += l;
+    std::sort(latencies.begin(),latencies.end());
+    cout << "[INF] Pass " << p << " latency (us): mean " << total/latencies.size()
+         << " p50 " << latencies[latencies.size()/2]
+         << " p99 " << latencies[(latencies.size()*99)/100]
+         << " max " << latencies.back() << endl;
+  }
+  for (int p=0; p<passes; p++) {
+    double elapsed = throughputPass(fd,frames,window);
+    if (elapsed<0) {
+      cerr << "[ERR] Connection lost" << endl;
+      return 1;
+    }
+    cout << "[INF] Pass " << p << " throughput (window " << window << "): "
+         << frames.size()/elapsed << " queries/s" << endl;
+  }
+  close(fd);
+  return 0;
+}
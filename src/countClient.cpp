@@ -0,0 +1,106 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+
+#include "countProtocol.h"
+
+
+using namespace std;
+
+static void show_usage(std::string name)
+{
+    std::cerr << "Usage: " << name << " <option(s)>"
+              << "Options:\n"
+              << "\t-h,--help\t\tShow this help message\n"
+              << "\t-s, PATH\tSpecify the path of the daemon socket. Default: " << COUNT_SOCKET_DEFAULT << "\n"
+              << "Reads pairs of lines (initial descriptor, final descriptor) from the standard input,\n"
+              << "sends them all to the daemon, then prints one count per pair."
+              << std::endl;
+}
+
+// Reads the values of a descriptor from a line
+static std::vector<uint64_t> readDescriptor(const std::string &line) {
+  std::vector<uint64_t> values;
+  std::stringstream ss(line);
+  uint64_t v;
+  while (ss >> v)
+    values.push_back(v);
+  return values;
+}
+
+int main(int argc, char *argv[]) {
+  std::string path = COUNT_SOCKET_DEFAULT;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "-h") || (arg == "--help")) {
+        show_usage(argv[0]);
+        return 0;
+    } else if ((arg == "-s")) {
+        if (i + 1 < argc) { // Make sure we aren't at the end of argv!
+            path = argv[++i];
+        } else { // Uh-oh, there was no argument to the destination option.
+            std::cerr << "The -s option requires one argument." << std::endl;
+            return 1;
+        }
+    } else {
+      show_usage(argv[0]);
+      return 1;
+    }
+  }
+
+  // Read the initial and final descriptors, two lines per query
+  std::string buffer;
+  std::string descriptor1;
+  std::string descriptor2;
+  uint32_t queries = 0;
+  while (getline(cin,descriptor1) && getline(cin,descriptor2)) {
+    countRequest request;
+    request.id   = queries;
+    request.init = readDescriptor(descriptor1);
+    request.end  = readDescriptor(descriptor2);
+    if (request.init.size()!=request.end.size() || request.init.empty() || request.init.size()>SMAX) {
+      cerr << "[ERR] Query " << queries << ": descriptors must have the same length, between 1 and " << SMAX << endl;
+      return 1;
+    }
+    encodeRequest(request,buffer);
+    queries++;
+  }
+
+  int fd = connectDaemon(path);
+  if (fd<0) {
+    cerr << "[ERR] Cannot connect to " << path << ": " << strerror(errno) << endl;
+    return 1;
+  }
+  // All the queries are pipelined; the daemon answers them in order
+  if (!writeAll(fd,buffer.data(),buffer.size())) {
+    cerr << "[ERR] Cannot send the queries" << endl;
+    close(fd);
+    return 1;
+  }
+  shutdown(fd,SHUT_WR);
+  char frame[COUNT_RESPONSE_SIZE];
+  int failures = 0;
+  for (uint32_t k=0;k<queries;k++) {
+    if (!readAll(fd,frame,COUNT_RESPONSE_SIZE)) {
+      cerr << "[ERR] Connection closed by the daemon" << endl;
+      close(fd);
+      return 1;
+    }
+    countResponse response;
+    decodeResponse(frame,response);
+    if (response.status==COUNT_OK)
+      cout << response.count << endl;
+    else {
+      if (response.status==COUNT_INCOMPATIBLE)
+        cout << "[ERR] The two partitions are not compatible" << endl;
+      else if (response.status==COUNT_OVERFLOW)
+        cout << "[ERR] The count does not fit in 64 bits" << endl;
+      else
+        cout << "[ERR] Invalid query" << endl;
+      failures++;
+    }
+  }
+  close(fd);
+  return failures>0 ? 1 : 0;
+}
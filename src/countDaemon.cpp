@@ -0,0 +1,234 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+
+#include "partitionCounting.h"
+#include "counting.h"
+#include "countProtocol.h"
+
+
+using namespace std;
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int) {
+    running = 0;
+}
+
+static void show_usage(std::string name)
+{
+    std::cerr << "Usage: " << name << " <option(s)>"
+              << "Options:\n"
+              << "\t-h,--help\t\tShow this help message\n"
+              << "\t-s, PATH\tSpecify the path of the Unix domain socket. Default: " << COUNT_SOCKET_DEFAULT << "\n"
+              << "\t-n, NUM\tSpecify the maximal sum of the descriptors (size of the binomial tables), at most " << SMAX << ". Default: " << SMAX << ".\n"
+              << "\t-m, NUM\tSpecify the maximal number of memoized sub-counts before the memo is flushed; each one takes about 130 bytes. Default: 4000000 (about 500 MB)."
+              << std::endl;
+}
+
+// Above this many buffered bytes (requests not processed, or responses not sent), the daemon
+// stops reading from a client until it drains its responses
+#define CLIENT_BUFFER_LIMIT (4<<20)
+
+// Per-client state: bytes received but not yet processed, and responses not yet sent
+struct client {
+    int fd;
+    bool eof;
+    std::string in;
+    std::string out;
+};
+
+// Answers one request with the warm counter
+static countResponse answer(Counter &ct, const countRequest &request) {
+    countResponse response;
+    response.id     = request.id;
+    response.status = COUNT_OK;
+    response.count  = 0;
+    unsigned int length = request.init.size();
+    if (length<1 || length>SMAX) {
+        response.status = COUNT_INVALID;
+        return response;
+    }
+    partitionDescriptor d1(request.init.data(),length);
+    partitionDescriptor d2(request.end.data(),length);
+    // The partition generation and the descriptors only handle sums up to SMAX
+    if (d1.get_sum()>ct.maxN() || d2.get_sum()>ct.maxN() || d1.get_sum()>SMAX || d2.get_sum()>SMAX) {
+        response.status = COUNT_INVALID;
+        return response;
+    }
+    if (!d2.descendent(d1)) {
+        response.status = COUNT_INCOMPATIBLE;
+        return response;
+    }
+    response.count = ct.recursiveCount_DescBreak(d1,d2);
+    if (response.count==COUNT_OVERFLOWED) {
+        response.status = COUNT_OVERFLOW;
+        response.count  = 0;
+    }
+    return response;
+}
+
+// Checks whether a complete request is waiting in the input buffer of a client
+static bool pending(const client &c) {
+    return c.in.size()>=COUNT_REQUEST_HEADER && c.in.size()>=requestSize(c.in.data());
+}
+
+// Processes the complete requests received from one client, until its output buffer is full
+// The memo is flushed as soon as it grows over maxMemo entries, also within a pipelined batch
+static void serve(Counter &ct, client &c, size_t maxMemo) {
+    size_t offset = 0;
+    countRequest request;
+    while (c.in.size()-offset>=COUNT_REQUEST_HEADER && c.out.size()<CLIENT_BUFFER_LIMIT) {
+        size_t size = requestSize(c.in.data()+offset);
+        if (c.in.size()-offset<size)
+            break;
+        decodeRequest(c.in.data()+offset,request);
+        encodeResponse(answer(ct,request),c.out);
+        offset += size;
+        if (ct.memoSize()>maxMemo) {
+            cout << "[INF] Flushing memo (" << ct.memoSize() << " entries)" << endl;
+            ct.clearMemo();
+        }
+    }
+    c.in.erase(0,offset);
+}
+
+int main(int argc, char *argv[]) {
+  std::string path = COUNT_SOCKET_DEFAULT;
+  int n = SMAX;
+  size_t maxMemo = 4000000;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "-h") || (arg == "--help")) {
+        show_usage(argv[0]);
+        return 0;
+    } else if ((arg == "-s") || (arg == "-n") || (arg == "-m")) {
+        if (i + 1 < argc) { // Make sure we aren't at the end of argv!
+            std::string value = argv[++i];
+            if (arg == "-s") path = value;
+            else if (arg == "-n") n = atoi(value.c_str());
+            else maxMemo = atol(value.c_str());
+        } else { // Uh-oh, there was no argument to the destination option.
+            std::cerr << "The " << arg << " option requires one argument." << std::endl;
+            return 1;
+        }
+    } else {
+      show_usage(argv[0]);
+      return 1;
+    }
+  }
+  if (n<1 || n>SMAX) {
+    cerr << "[ERR] n should be between 1 and " << SMAX << endl;
+    return 1;
+  }
+
+  // Tables are built once; sub-counts are memoized on (init,end) pairs and kept across requests
+  cout << "[INF] Building counter tables for n=" << n << endl;
+  Counter ct(n,false,true);
+
+  sockaddr_un address;
+  if (!socketAddress(path,address)) {
+    cerr << "[ERR] Socket path too long: " << path << endl;
+    return 1;
+  }
+  // Only a stale socket may be replaced: not another kind of file, nor the socket of a running daemon
+  struct stat st;
+  if (lstat(path.c_str(),&st)==0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      cerr << "[ERR] " << path << " exists and is not a socket" << endl;
+      return 1;
+    }
+    int other = connectDaemon(path);
+    if (other>=0) {
+      close(other);
+      cerr << "[ERR] Another daemon is listening on " << path << endl;
+      return 1;
+    }
+    unlink(path.c_str());
+  }
+  int listener = socket(AF_UNIX,SOCK_STREAM,0);
+  if (listener<0 || bind(listener,(sockaddr*)&address,sizeof(address))<0 || listen(listener,64)<0) {
+    cerr << "[ERR] Cannot listen on " << path << ": " << strerror(errno) << endl;
+    return 1;
+  }
+  fcntl(listener,F_SETFL,O_NONBLOCK);
+  signal(SIGINT,stop);
+  signal(SIGTERM,stop);
+  signal(SIGPIPE,SIG_IGN);
+  cout << "[INF] Listening on " << path << endl;
+
+  std::vector<client> clients;
+  std::vector<pollfd> fds;
+  char buffer[65536];
+  while (running) {
+    fds.clear();
+    fds.push_back({listener,POLLIN,0});
+    for (auto &c : clients)
+      fds.push_back({c.fd,(short)((c.eof || c.in.size()>=CLIENT_BUFFER_LIMIT || c.out.size()>=CLIENT_BUFFER_LIMIT?0:POLLIN)|(c.out.empty()?0:POLLOUT)),0});
+    if (poll(fds.data(),fds.size(),-1)<0) {
+      if (errno==EINTR) continue;
+      cerr << "[ERR] poll: " << strerror(errno) << endl;
+      break;
+    }
+    // Pending connections
+    if (fds[0].revents & POLLIN) {
+      int fd;
+      while ((fd = accept(listener,NULL,NULL))>=0) {
+        fcntl(fd,F_SETFL,O_NONBLOCK);
+        clients.push_back({fd,false,"",""});
+      }
+    }
+    // Clients: read what is available (within the buffer limit), answer the complete requests, then write back
+    for (unsigned int k=1;k<fds.size();k++) {
+      client &c = clients[k-1];
+      bool closed = false;
+      if (fds[k].revents==0)
+        continue;
+      if (fds[k].revents & (POLLIN|POLLHUP|POLLERR)) {
+        ssize_t r = 1;
+        while (c.in.size()<CLIENT_BUFFER_LIMIT && (r = read(c.fd,buffer,sizeof(buffer)))>0)
+          c.in.append(buffer,r);
+        // On end-of-file, the pending responses are still sent before closing
+        if (r==0)
+          c.eof = true;
+        else if (r<0 && errno!=EAGAIN && errno!=EWOULDBLOCK && errno!=EINTR)
+          closed = true;
+      }
+      // Answer and write back until the client stops reading or no complete request is left
+      while (!closed) {
+        serve(ct,c,maxMemo);
+        while (!c.out.empty()) {
+          ssize_t w = write(c.fd,c.out.data(),c.out.size());
+          if (w<=0) {
+            if (w<0 && errno!=EAGAIN && errno!=EWOULDBLOCK && errno!=EINTR)
+              closed = true;
+            break;
+          }
+          c.out.erase(0,w);
+        }
+        if (c.out.size()>=CLIENT_BUFFER_LIMIT || !pending(c))
+          break;
+      }
+      if (closed || (c.eof && c.out.empty())) {
+        close(c.fd);
+        c.fd = -1;
+      }
+    }
+    for (unsigned int k=0;k<clients.size();)
+      if (clients[k].fd<0) {
+        clients[k] = clients.back();
+        clients.pop_back();
+      } else k++;
+  }
+
+  for (auto &c : clients)
+    close(c.fd);
+  close(listener);
+  unlink(path.c_str());
+  Counter::printCalls();
+  return 0;
+}
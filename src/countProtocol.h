@@ -0,0 +1,146 @@
+// @author: jbhayet
+// Binary protocol between countDaemon and its clients, over a Unix domain socket.
+// All the fields are in host byte order (the socket is local).
+//
+// Request:  uint32 id | uint8 length | uint8[3] padding | uint32 d_init[length] | uint32 d_end[length]
+// Response: uint32 id | uint8 status | uint8[3] padding | uint64 count
+//
+// Clients may send several requests before reading the responses (pipelining);
+// responses on one connection always come back in the order of the requests.
+#ifndef __COUNT_PROTOCOL__
+#define __COUNT_PROTOCOL__
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "partitionDescriptor.h"
+
+#define COUNT_SOCKET_DEFAULT "/tmp/countSFS.sock"
+#define COUNT_REQUEST_HEADER  8
+#define COUNT_RESPONSE_SIZE   16
+
+// Status codes of the responses
+enum countStatus : uint8_t {
+  COUNT_OK           = 0,
+  COUNT_INCOMPATIBLE = 1, // d_end is not a descendent of d_init
+  COUNT_INVALID      = 2, // Bad length, or sum too high for the counter tables
+  COUNT_OVERFLOW     = 3  // The count does not fit in 64 bits
+};
+
+struct countRequest {
+  uint32_t id;
+  std::vector<uint64_t> init;
+  std::vector<uint64_t> end;
+};
+
+struct countResponse {
+  uint32_t id;
+  uint8_t  status;
+  uint64_t count;
+};
+
+// Size of a full request frame, given its header
+inline size_t requestSize(const char *header) {
+  return COUNT_REQUEST_HEADER+2*sizeof(uint32_t)*(uint8_t)header[4];
+}
+
+// Appends the encoded request to a buffer
+inline void encodeRequest(const countRequest &request, std::string &buffer) {
+  char header[COUNT_REQUEST_HEADER] = {0};
+  memcpy(header,&request.id,sizeof(uint32_t));
+  header[4] = (uint8_t)request.init.size();
+  buffer.append(header,COUNT_REQUEST_HEADER);
+  for (auto v : request.init) {
+    uint32_t u = v;
+    buffer.append(reinterpret_cast<const char*>(&u),sizeof(u));
+  }
+  for (auto v : request.end) {
+    uint32_t u = v;
+    buffer.append(reinterpret_cast<const char*>(&u),sizeof(u));
+  }
+}
+
+// Decodes a full request frame (requestSize(frame) bytes)
+inline void decodeRequest(const char *frame, countRequest &request) {
+  memcpy(&request.id,frame,sizeof(uint32_t));
+  unsigned int length = (uint8_t)frame[4];
+  request.init.resize(length);
+  request.end.resize(length);
+  const char *p = frame+COUNT_REQUEST_HEADER;
+  for (unsigned int k=0;k<2*length;k++,p+=sizeof(uint32_t)) {
+    uint32_t u;
+    memcpy(&u,p,sizeof(u));
+    if (k<length) request.init[k] = u;
+    else          request.end[k-length] = u;
+  }
+}
+
+// Appends the encoded response to a buffer
+inline void encodeResponse(const countResponse &response, std::string &buffer) {
+  char frame[COUNT_RESPONSE_SIZE] = {0};
+  memcpy(frame,&response.id,sizeof(uint32_t));
+  frame[4] = response.status;
+  memcpy(frame+8,&response.count,sizeof(uint64_t));
+  buffer.append(frame,COUNT_RESPONSE_SIZE);
+}
+
+// Decodes a response frame (COUNT_RESPONSE_SIZE bytes)
+inline void decodeResponse(const char *frame, countResponse &response) {
+  memcpy(&response.id,frame,sizeof(uint32_t));
+  response.status = frame[4];
+  memcpy(&response.count,frame+8,sizeof(uint64_t));
+}
+
+// Fills the socket address for a given path; returns false if the path is too long
+inline bool socketAddress(const std::string &path, sockaddr_un &address) {
+  memset(&address,0,sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size()>=sizeof(address.sun_path))
+    return false;
+  strncpy(address.sun_path,path.c_str(),sizeof(address.sun_path)-1);
+  return true;
+}
+
+// Connects to the daemon; returns -1 on failure
+inline int connectDaemon(const std::string &path) {
+  sockaddr_un address;
+  if (!socketAddress(path,address))
+    return -1;
+  int fd = socket(AF_UNIX,SOCK_STREAM,0);
+  if (fd<0)
+    return -1;
+  if (connect(fd,(sockaddr*)&address,sizeof(address))<0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Blocking write of a full buffer
+inline bool writeAll(int fd, const char *data, size_t size) {
+  while (size>0) {
+    ssize_t w = write(fd,data,size);
+    if (w<0 && errno==EINTR) continue;
+    if (w<=0) return false;
+    data += w;
+    size -= w;
+  }
+  return true;
+}
+
+// Blocking read of a full buffer
+inline bool readAll(int fd, char *data, size_t size) {
+  while (size>0) {
+    ssize_t r = read(fd,data,size);
+    if (r<0 && errno==EINTR) continue;
+    if (r<=0) return false;
+    data += r;
+    size -= r;
+  }
+  return true;
+}
+#endif
@@ -1,12 +1,34 @@
 // @author: jbhayet
 #include "partitionDescriptor.h"
+#include <unordered_map>
 #include <Eigen/Dense>
 
 typedef Eigen::Matrix< unsigned int, Eigen::Dynamic, Eigen::Dynamic > 	MatrixXUL;
+typedef Eigen::Matrix< uint64_t, Eigen::Dynamic, Eigen::Dynamic > 	MatrixXU64;
 
-#define HASH_TABLE_SIZE 3000000
+// Must be above partitionDescriptor::maxKey()
+#define HASH_TABLE_SIZE 3694084
 #define HASH_USE 1
+// Returned when a count does not fit in 64 bits
+#define COUNT_OVERFLOWED UINT64_MAX
 uint64_t hash_table[HASH_TABLE_SIZE];
+
+// Exact memo key: packed signatures of the (init,end) pair
+struct pairKey {
+  uint64_t words[SIGNATURE_WORDS];
+  inline bool operator==(const pairKey &other) const {
+    return memcmp(words,other.words,sizeof(words))==0;
+  }
+};
+
+struct pairKeyHash {
+  inline size_t operator()(const pairKey &key) const {
+    uint64_t h = 0;
+    for (unsigned int i=0;i<SIGNATURE_WORDS;i++)
+      h ^= key.words[i] + 0x9e3779b97f4a7c15ULL + (h<<6) + (h>>2);
+    return h;
+  }
+};
 class Counter {
   bool debug;
   // values= -np.ones((100000000,1), dtype=int)
@@ -14,12 +36,18 @@ class Counter {
   // shortened  = 0
   MatrixXUL countSplittingTable;
   MatrixXUL combinationsTable;
+  // Memo keyed on the (init,end) pair: unlike hash_table, it stays valid
+  // across different end descriptors, so it does not need to be reset
+  bool persistent;
+  // Length of the descriptors whose counts are not memoized (0: all of them are)
+  unsigned int unmemoizedLength;
+  std::unordered_map<pairKey,uint64_t,pairKeyHash> memo;
   static unsigned int calls;
   static unsigned int shortened;
 
 public:
   // Constructor
-  Counter(unsigned int n, bool dbg=false) : debug(dbg) {
+  Counter(unsigned int n, bool dbg=false, bool persist=false) : debug(dbg), persistent(persist), unmemoizedLength(0) {
     countSplittingTable = MatrixXUL::Zero(n+3,n+3);
     combinationsTable   = MatrixXUL::Zero(n+3,n+3);
     initCombinationsTable(n+3);
@@ -57,15 +85,38 @@ public:
           countSplittingTable(i,j) = countSplitting(i,j);
   }
 
+  // Only needed by the d_init-keyed hash table, when the end descriptor changes
   inline void resetValues() {
+    if (persistent)
+      return;
     memset(hash_table,0,HASH_TABLE_SIZE*sizeof(hash_table[0]));
   }
 
+  // Persistent memo handling
+  inline size_t memoSize() const {
+    return memo.size();
+  }
+
+  inline void clearMemo() {
+    memo.clear();
+  }
+
+  // Stops memoizing the counts from descriptors of a given length, e.g. the top-level ones
+  // when each of their pairs is queried once (the recursive calls only see shorter descriptors)
+  inline void setUnmemoizedLength(unsigned int length) {
+    unmemoizedLength = length;
+  }
+
+  // Maximal value of n for which the tables have been built
+  inline unsigned int maxN() const {
+    return combinationsTable.rows()-3;
+  }
+
   static void printCalls() {
     std::cout << "[INF] Calls " << calls << " vs. " << shortened << std::endl;
   }
   // Descend-and-Break recursive algorithm
-  unsigned int recursiveCount_DescBreak(const partitionDescriptor&d_init,
+  uint64_t recursiveCount_DescBreak(const partitionDescriptor&d_init,
                                         const partitionDescriptor&d_end) {
     // global calls
     calls++;
@@ -86,7 +137,21 @@ public:
 
     // If the computation has already been done, do not repeat it!
 #if HASH_USE
-    unsigned int key = d_init.key();
+    pairKey signature;
+    bool memoize = persistent && d_init.size()!=unmemoizedLength;
+    if (memoize) {
+      unsigned int bit = 0;
+      memset(signature.words,0,sizeof(signature.words));
+      d_init.packSignature(signature.words,bit);
+      d_end.packSignature(signature.words,bit);
+      auto it = memo.find(signature);
+      if (it!=memo.end()) {
+        shortened++;
+        return it->second;
+      }
+    }
+    // The d_init-keyed hash table is only used without the persistent memo
+    unsigned int key = persistent ? 0 : d_init.key();
     if (key>0 && key<HASH_TABLE_SIZE && hash_table[key]>0) {
       shortened++;
       return hash_table[key];
@@ -149,14 +214,22 @@ public:
             if (debug) {
               std::cout << "[DBG] count from recursive call: " << nsub << std::endl;
             }
-            count += ns*nc*nsub;
+            // Counts that do not fit in 64 bits saturate to COUNT_OVERFLOWED, also through the memo
+            uint64_t term;
+            if (nsub==COUNT_OVERFLOWED || __builtin_mul_overflow(ns,nc,&term) ||
+                __builtin_mul_overflow(term,nsub,&term) || __builtin_add_overflow(count,term,&count)) {
+              count = COUNT_OVERFLOWED;
+              break;
+            }
           }
         else
           if (debug)
             std::cout << "[DBG] Invalid partition" << std::endl;
     }
 #if HASH_USE
-    if (key>0 && key<HASH_TABLE_SIZE)
+    if (memoize)
+        memo[signature]=count;
+    else if (!persistent && key>0 && key<HASH_TABLE_SIZE)
         hash_table[key]=count;
 #endif
     return count;
@@ -16,60 +16,34 @@ using namespace std;
 #include <chrono>
 typedef std::chrono::high_resolution_clock Clock;
 
-// define the format you want, you only need one instance of this...
-const static IOFormat CSVFormat(StreamPrecision, DontAlignCols, ", ", "\n");
-
 static void show_usage(std::string name)
 {
     std::cerr << "Usage: " << name << " <option(s)>"
               << "Options:\n"
               << "\t-h,--help\t\tShow this help message\n"
-              << "\t-n, NUM\tSpecify the number n from which the partitions are generated. Default: 20."
+              << "\t-n, NUM\tSpecify the number n from which the partitions are generated. Default: 20.\n"
+              << "\t--range, A..B\tGenerate the outputs for all the values of n from A to B in a single run.\n"
+              << "\t-m, NUM\tWith --range, specify the maximal number of memoized sub-counts before the memo is flushed. Default: 10000000."
               << std::endl;
 }
 
 
-// To write the results in a CSV file
-void writeToCSVfile(const string &name, const MatrixXUL &matrix) {
+// To write the results in a CSV file; counts that do not fit in 64 bits are written as nan
+void writeToCSVfile(const string &name, const MatrixXU64 &matrix) {
     std::ofstream file(name.c_str());
-    file << matrix.format(CSVFormat);
-}
-
-int main(int argc, char *argv[]) {
-  // n is the maximum sum of the elements of the compositions
-  int n=25;
-  for (int i = 1; i < argc; ++i) {
-    std::string arg = argv[i];
-    if ((arg == "-h") || (arg == "--help")) {
-        show_usage(argv[0]);
-        return 0;
-    } else if ((arg == "-n")) {
-        if (i + 1 < argc) { // Make sure we aren't at the end of argv!
-            n = atoi(argv[++i]); // Increment 'i' so we don't get the argument as the next argv[i].
-        } else { // Uh-oh, there was no argument to the destination option.
-            std::cerr << "The -n option requires one argument." << std::endl;
-            return 1;
-        }
-    } else {
-      show_usage(argv[0]);
-      return 1;
+    for (int i=0; i<matrix.rows(); i++) {
+      if (i>0) file << "\n";
+      for (int j=0; j<matrix.cols(); j++) {
+        if (j>0) file << ", ";
+        if (matrix(i,j)==COUNT_OVERFLOWED) file << "nan";
+        else file << matrix(i,j);
+      }
     }
-  }
-
-  // Definition of the alpha parameter, choose a value in (0,2)
-  // double alpha = 20.0;
-  // This object will be called for counting the partitions
-  Counter ct(n);
-  // Partition generation
-  cout << "[INF] Generating partitions of n=" << n << std::endl;
-  // Enumerate all the partitions [a_1,...,a_n] from n, such that sum_i i a_i = n. 
-  // They will come in ascending lexicographical order
-  std::list<std::vector<unsigned int> >partitionsOfN;
-  ascPartition(n,partitionsOfN);
+}
 
-  // Add the trivial one because the algorithm does not give it as an output
-  std::vector<unsigned int> trivialPartition; trivialPartition.push_back(n);
-  partitionsOfN.push_back(trivialPartition);
+// Computes the Combin matrix for all the partitions of n (trivial one included) and writes it to Combin-n.csv
+// The memo of ct is flushed when it grows over maxMemo entries
+void computeCombin(int n, const std::list<std::vector<unsigned int> > &partitionsOfN, Counter &ct, size_t maxMemo=SIZE_MAX) {
   cout << "[INF] First partition" << std::endl;
   printPartition(partitionsOfN.front());
 
@@ -109,24 +83,128 @@ int main(int argc, char *argv[]) {
 
   // Precompute all the Cbr or read them from file
   std::cout << "[INF] Computing counts" << std::endl;
-  MatrixXUL Combin(dim,dim);
+  MatrixXU64 Combin = MatrixXU64::Zero(dim,dim);
+  int overflows = 0;
   for (int j=0; j<dim; j++) {
     printBar((float)j/dim);
     ct.resetValues();
     for (int i=0; i<j; i++) {
       Combin(i,j)=ct.recursiveCount_DescBreak(P[i],P[j]);
+      if (Combin(i,j)==COUNT_OVERFLOWED)
+        overflows++;
     }
+    if (ct.memoSize()>maxMemo)
+      ct.clearMemo();
   }
   auto t2 = Clock::now();
   std::cout << std::endl;
   std::cout << "[INF] Took: " << std::chrono::duration_cast<std::chrono::seconds>(t2 - t1).count() << " seconds" << std::endl;
 
   Counter::printCalls();
+  if (overflows>0)
+    std::cerr << "[WRN] " << overflows << " counts do not fit in 64 bits for n=" << n << "; they are written as nan" << std::endl;
 
   std::string fileName;
   std::stringstream ss(fileName);
   ss << "Combin-" << setw(3) << setfill('0') << n << ".csv";
   writeToCSVfile(ss.str(),Combin);
+}
+
+int main(int argc, char *argv[]) {
+  // n is the maximum sum of the elements of the compositions
+  int n=25;
+  // Range of values of n [nFirst,nLast], when given
+  int nFirst=0, nLast=0;
+  size_t maxMemo=10000000;
+  bool nGiven=false, mGiven=false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "-h") || (arg == "--help")) {
+        show_usage(argv[0]);
+        return 0;
+    } else if ((arg == "-n")) {
+        if (i + 1 < argc) { // Make sure we aren't at the end of argv!
+            n = atoi(argv[++i]); // Increment 'i' so we don't get the argument as the next argv[i].
+            nGiven = true;
+        } else { // Uh-oh, there was no argument to the destination option.
+            std::cerr << "The -n option requires one argument." << std::endl;
+            return 1;
+        }
+    } else if ((arg == "-m")) {
+        if (i + 1 < argc) {
+            maxMemo = atol(argv[++i]);
+            mGiven = true;
+        } else {
+            std::cerr << "The -m option requires one argument." << std::endl;
+            return 1;
+        }
+    } else if ((arg == "--range")) {
+        // The whole argument must be consumed
+        int consumed = 0;
+        if (i + 1 < argc && sscanf(argv[i+1],"%d..%d%n",&nFirst,&nLast,&consumed)==2 && argv[i+1][consumed]=='\0') {
+            i++;
+        } else {
+            std::cerr << "The --range option requires one argument of the form a..b." << std::endl;
+            return 1;
+        }
+        if (nFirst<1 || nFirst>nLast || nLast>SMAX) {
+            std::cerr << "The --range bounds should satisfy 1<=a<=b<=" << SMAX << "." << std::endl;
+            return 1;
+        }
+    } else {
+      show_usage(argv[0]);
+      return 1;
+    }
+  }
+  if (nGiven && nLast>0) {
+    std::cerr << "The -n and --range options cannot be used together." << std::endl;
+    return 1;
+  }
+  if (mGiven && nLast==0) {
+    std::cerr << "The -m option only applies with --range." << std::endl;
+    return 1;
+  }
+
+  if (nLast>0) {
+    // Single pipeline for the whole range: the tables are sized for the largest n, and the
+    // sub-counts, memoized on (init,end) pairs, are reused from one value of n to the next
+    Counter ct(nLast,false,true);
+    std::list<std::vector<unsigned int> >partitionsOfN;
+    std::list<std::vector<unsigned int> >partitionsOfPrevious;
+    for (n=nFirst; n<=nLast; n++) {
+      cout << "[INF] Generating partitions of n=" << n << std::endl;
+      if (n==nFirst) {
+        ascPartition(n,partitionsOfN);
+        std::vector<unsigned int> trivialPartition; trivialPartition.push_back(n);
+        partitionsOfN.push_back(trivialPartition);
+      } else {
+        // The partitions of n are obtained from the ones of n-1
+        partitionsOfPrevious.swap(partitionsOfN);
+        extendPartitions(partitionsOfPrevious,partitionsOfN);
+      }
+      // The top-level pairs are all different: only the sub-counts can be reused
+      ct.setUnmemoizedLength(n);
+      computeCombin(n,partitionsOfN,ct,maxMemo);
+      cout << "[INF] Memoized sub-counts: " << ct.memoSize() << std::endl;
+    }
+    return 0;
+  }
+
+  // Definition of the alpha parameter, choose a value in (0,2)
+  // double alpha = 20.0;
+  // This object will be called for counting the partitions
+  Counter ct(n);
+  // Partition generation
+  cout << "[INF] Generating partitions of n=" << n << std::endl;
+  // Enumerate all the partitions [a_1,...,a_n] from n, such that sum_i i a_i = n. 
+  // They will come in ascending lexicographical order
+  std::list<std::vector<unsigned int> >partitionsOfN;
+  ascPartition(n,partitionsOfN);
+
+  // Add the trivial one because the algorithm does not give it as an output
+  std::vector<unsigned int> trivialPartition; trivialPartition.push_back(n);
+  partitionsOfN.push_back(trivialPartition);
+  computeCombin(n,partitionsOfN,ct);
 
   return 0;
 
@@ -2,6 +2,7 @@
 #include <list>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include "partitionDescriptor.h"
 
 // TODO: this value should be updated
@@ -93,3 +94,22 @@ void ascPartitionVariant(unsigned int n,unsigned int p, const partitionDescripto
   recAscVariant(n,p,1,1,d,listOfPartitions);
   return;
 }
+
+// Generates all the partitions of n (trivial one included) from all the partitions of n-1, in ascending lexicographical order
+// Each partition of n is obtained from exactly one partition p of n-1:
+//  - by adding a 1, if it contains a 1,
+//  - by incrementing the smallest element of p, otherwise (only possible if this element is unique in p)
+void extendPartitions(const std::list<std::vector<unsigned int> > &partitionsOfNm1, std::list<std::vector<unsigned int> > &partitionsOfN) {
+  partitionsOfN.clear();
+  for (auto &partition: partitionsOfNm1) {
+    std::vector<unsigned int> withOne(partition.size()+1,1);
+    std::copy(partition.begin(),partition.end(),withOne.begin()+1);
+    partitionsOfN.push_back(withOne);
+    if (partition.size()==1 || partition[0]<partition[1]) {
+      std::vector<unsigned int> incremented(partition);
+      incremented[0]++;
+      partitionsOfN.push_back(incremented);
+    }
+  }
+  partitionsOfN.sort();
+}
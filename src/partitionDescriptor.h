@@ -13,6 +13,11 @@
 
 #define SMAX 30
 #define HASH_CHARS 4
+// Packed signatures: the length and each entry (all at most SMAX when the sum is at most SMAX)
+// take SIGNATURE_BITS bits; SIGNATURE_WORDS words hold the signatures of two descriptors
+#define SIGNATURE_BITS 5
+#define SIGNATURE_WORDS 5
+static_assert(SMAX<(1<<SIGNATURE_BITS) && 2*(SMAX+1)*SIGNATURE_BITS<=64*SIGNATURE_WORDS,"Signatures do not fit");
 
 typedef Eigen::Matrix< unsigned int, Eigen::Dynamic, Eigen::Dynamic > 	MatrixXUL;
 
@@ -160,20 +165,33 @@ class partitionDescriptor {
 
     // Determine the max key (for using hashing)
     static uint64_t maxKey() {
-        uint64_t k = SMAX;
-        for (unsigned int i=1;i<=HASH_CHARS;i++)
-            k = k*SMAX+SMAX;
-        return k;
+        uint64_t k = 0;
+        for (unsigned int i=0;i<HASH_CHARS;i++)
+            k = k*(SMAX+1)+SMAX;
+        return k*HASH_CHARS+HASH_CHARS-1;
     }
 
     // Determine a key (for using hashing)
+    // Entries are digits in base SMAX+1, and the length is encoded too, so that descriptors
+    // of different lengths never share a key
     inline uint64_t key() const {
-        if (this->length>HASH_CHARS)
+        if (this->length>HASH_CHARS || this->length==0)
             return -1;
-        uint64_t k = this->data[0];
-        for (unsigned int i=1;i<this->length;i++)
-            k = k*SMAX+this->data[i];
-        return k;
+        uint64_t k = 0;
+        for (unsigned int i=0;i<this->length;i++)
+            k = k*(SMAX+1)+this->data[i];
+        return k*HASH_CHARS+this->length-1;
+    }
+
+    // Packs the full signature of the descriptor (length and data) into words, starting at bit; used as an exact memo key
+    inline void packSignature(uint64_t *words, unsigned int &bit) const {
+        for (unsigned int k=0;k<=this->length;k++,bit+=SIGNATURE_BITS) {
+            uint64_t v = (k==0) ? this->length : this->data[k-1];
+            unsigned int shift = bit%64;
+            words[bit/64] |= v<<shift;
+            if (shift+SIGNATURE_BITS>64)
+                words[bit/64+1] |= v>>(64-shift);
+        }
     }
 
     // Determine the highest index such that d[k]>initial.d[k] and d[j]==initial.d[j] for j>k